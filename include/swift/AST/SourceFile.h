@@ -22,6 +22,8 @@
 
 namespace swift {
 
+class AbstractFunctionDecl;
+class IterableDeclContext;
 class PersistentParserState;
 
 /// A file containing Swift source code.
@@ -162,6 +164,12 @@ private:
   ParserStatePtr DelayedParserState =
       ParserStatePtr(/*ptr*/ nullptr, /*deleter*/ nullptr);
 
+  /// Function bodies and member lists whose parsing was delayed, in the order
+  /// the parser encountered them. These let \c performDelayedParsing() find
+  /// the delayed regions directly instead of walking the whole AST for them.
+  std::vector<AbstractFunctionDecl *> DelayedFunctionBodies;
+  std::vector<IterableDeclContext *> DelayedMemberLists;
+
   friend ASTContext;
 
 public:
@@ -456,6 +464,29 @@ public:
     DelayedParserState = std::move(state);
   }
 
+  /// Note that parsing of \p AFD's body was delayed.
+  void recordDelayedFunctionBody(AbstractFunctionDecl *AFD) {
+    DelayedFunctionBodies.push_back(AFD);
+  }
+
+  /// Note that parsing of \p IDC's member list was delayed.
+  void recordDelayedMemberList(IterableDeclContext *IDC) {
+    DelayedMemberLists.push_back(IDC);
+  }
+
+  /// The function bodies whose parsing the parser delayed, in parse order.
+  /// Entries stay in the list once their body has been re-parsed; the list
+  /// may grow while delayed regions are being re-parsed.
+  ArrayRef<AbstractFunctionDecl *> getDelayedFunctionBodies() const {
+    return DelayedFunctionBodies;
+  }
+
+  /// The member lists whose parsing the parser delayed, in parse order. The
+  /// same growth caveat as for \c getDelayedFunctionBodies() applies.
+  ArrayRef<IterableDeclContext *> getDelayedMemberLists() const {
+    return DelayedMemberLists;
+  }
+
   SWIFT_DEBUG_DUMP;
   void dump(raw_ostream &os, bool parseIfNeeded = false) const;
 
@@ -25,6 +25,8 @@
 #include "swift/Parse/ParsedTrivia.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
+#include <vector>
 
 namespace swift {
 
@@ -508,6 +510,14 @@ public:
     return getStringLiteralSegments(Str, Segments, Diags);
   }
 
+  /// Whether a string literal token contains any interpolation segments.
+  ///
+  /// This applies the same escape and custom-delimiter rules as
+  /// \c getStringLiteralSegments, but answers without building the segment
+  /// list, so callers can cheaply skip interpolation handling for the common
+  /// plain literal.
+  static bool stringLiteralContainsInterpolation(const Token &Str);
+
   static SourceLoc getSourceLoc(const char *Loc) {
     return SourceLoc(llvm::SMLoc::getFromPointer(Loc));
   }
@@ -515,6 +525,16 @@ public:
   /// Get the token that starts at the given location.
   Token getTokenAt(SourceLoc Loc);
 
+  /// Try to form the token that remains after splitting the first \p SplitLen
+  /// characters off the operator token \p Tok, without re-lexing.
+  ///
+  /// This only succeeds when the remainder consists entirely of angle
+  /// brackets (the nested generic argument case, e.g. '>>'); any other
+  /// remainder may hit one of the special cases in operator lexing and
+  /// returns \c None, meaning the caller has to re-lex from the split point.
+  Optional<Token> getSplitRemainderToken(const Token &Tok,
+                                         size_t SplitLen) const;
+
   /// SILBodyRAII - This helper class is used when parsing a SIL body to inform
   /// the lexer that SIL-specific lexing should be enabled.
   struct SILBodyRAII {
@@ -640,6 +660,90 @@ Iterator token_lower_bound(ArrayTy &Array, SourceLoc Loc) {
 ArrayRef<Token> slice_token_array(ArrayRef<Token> AllTokens, SourceLoc StartLoc,
                                   SourceLoc EndLoc);
 
+/// Tokenizes a string literal, taking into account string interpolation.
+void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
+                         const SourceManager &SM, int BufID,
+                         std::vector<Token> &Toks);
+
+/// Lex the given buffer range, feeding each token and its surrounding trivia
+/// to \p DestFunc, which must be callable as
+/// \code
+///   DestFunc(const Token &Tok, StringRef LeadingTrivia,
+///            StringRef TrailingTrivia);
+/// \endcode
+/// including the final eof token. Unlike the vector-returning \c tokenize
+/// overload in Subsystems.h this never materializes the token stream, so
+/// streaming consumers pay no memory proportional to the buffer size.
+template <typename DF>
+void tokenize(const LangOptions &LangOpts, const SourceManager &SM,
+              unsigned BufferID, unsigned Offset, unsigned EndOffset,
+              DiagnosticEngine *Diags,
+              CommentRetentionMode RetainComments,
+              TriviaRetentionMode TriviaRetention,
+              bool TokenizeInterpolatedString, ArrayRef<Token> SplitTokens,
+              DF &&DestFunc) {
+  assert((TriviaRetention != TriviaRetentionMode::WithTrivia ||
+          !TokenizeInterpolatedString) &&
+         "string interpolation with trivia is not implemented yet");
+
+  if (Offset == 0 && EndOffset == 0)
+    EndOffset = SM.getRangeForBuffer(BufferID).getByteLength();
+
+  Lexer L(LangOpts, SM, BufferID, Diags, LexerMode::Swift,
+          HashbangMode::Allowed, RetainComments, TriviaRetention, Offset,
+          EndOffset);
+
+  // Keep the reset tokens sorted by location and walk them with a cursor in
+  // step with the lexed tokens. This costs one sort of a (tiny) local vector
+  // up front instead of a node allocation per split token and a tree lookup
+  // per lexed token.
+  SmallVector<Token, 4> ResetTokens(SplitTokens.begin(), SplitTokens.end());
+  std::sort(ResetTokens.begin(), ResetTokens.end(),
+            [&](const Token &A, const Token &B) {
+              return SM.isBeforeInBuffer(A.getLoc(), B.getLoc());
+            });
+  unsigned NextResetToken = 0;
+
+  Token Tok;
+  StringRef LeadingTrivia, TrailingTrivia;
+  do {
+    L.lex(Tok, LeadingTrivia, TrailingTrivia);
+
+    // If the token has the same location as a reset location,
+    // reset the token stream
+    while (NextResetToken != ResetTokens.size() &&
+           SM.isBeforeInBuffer(ResetTokens[NextResetToken].getLoc(),
+                               Tok.getLoc()))
+      ++NextResetToken;
+    if (NextResetToken != ResetTokens.size() &&
+        ResetTokens[NextResetToken].getLoc() == Tok.getLoc()) {
+      const Token &Reset = ResetTokens[NextResetToken++];
+      assert(Reset.isNot(tok::string_literal));
+
+      DestFunc(Reset, /*LeadingTrivia=*/StringRef(),
+               /*TrailingTrivia=*/StringRef());
+
+      auto NewState = L.getStateForBeginningOfTokenLoc(
+          Reset.getLoc().getAdvancedLoc(Reset.getLength()));
+      L.restoreState(NewState);
+      continue;
+    }
+
+    if (Tok.is(tok::string_literal) && TokenizeInterpolatedString &&
+        Lexer::stringLiteralContainsInterpolation(Tok)) {
+      std::vector<Token> StrTokens;
+      getStringPartTokens(Tok, LangOpts, SM, BufferID, StrTokens);
+      for (auto &StrTok : StrTokens) {
+        DestFunc(StrTok, /*LeadingTrivia=*/StringRef(),
+                 /*TrailingTrivia=*/StringRef());
+      }
+    } else {
+      DestFunc(Tok, LeadingTrivia, TrailingTrivia);
+    }
+
+  } while (Tok.getKind() != tok::eof);
+}
+
 } // end namespace swift
 
 #endif
@@ -118,7 +118,10 @@ public:
   Lexer *L;
   SILParserStateBase *SIL; // Non-null when parsing SIL decls.
   PersistentParserState *State;
-  std::unique_ptr<PersistentParserState> OwnedState;
+  /// In-line storage for \c State when no state was handed in from outside.
+  /// Stored in the parser itself so that the many short-lived parsers created
+  /// for delayed parsing do not pay a separate heap allocation each.
+  Optional<PersistentParserState> OwnedState;
   DeclContext *CurDeclContext;
   ASTContext &Context;
   CodeCompletionCallbacks *CodeCompletion = nullptr;
@@ -385,12 +388,18 @@ public:
   bool AvailabilityMacrosComputed = false;
 
 public:
+  /// The \p Offset and \p EndOffset parameters limit the parser's lexer to a
+  /// sub-range of the buffer. Passing zero for both scans the whole buffer.
+  /// Restricting the range avoids lexing from the top of the buffer when
+  /// re-parsing a delayed region of a source file.
   Parser(unsigned BufferID, SourceFile &SF, DiagnosticEngine* LexerDiags,
          SILParserStateBase *SIL, PersistentParserState *PersistentState,
-         std::shared_ptr<SyntaxParseActions> SPActions = nullptr);
+         std::shared_ptr<SyntaxParseActions> SPActions = nullptr,
+         unsigned Offset = 0, unsigned EndOffset = 0);
   Parser(unsigned BufferID, SourceFile &SF, SILParserStateBase *SIL,
          PersistentParserState *PersistentState = nullptr,
-         std::shared_ptr<SyntaxParseActions> SPActions = nullptr);
+         std::shared_ptr<SyntaxParseActions> SPActions = nullptr,
+         unsigned Offset = 0, unsigned EndOffset = 0);
   Parser(std::unique_ptr<Lexer> Lex, SourceFile &SF,
          SILParserStateBase *SIL = nullptr,
          PersistentParserState *PersistentState = nullptr,
@@ -534,7 +543,11 @@ public:
   // Utilities
 
   /// Return the next token that will be installed by \c consumeToken.
-  const Token &peekToken();
+  ///
+  /// The lexer always keeps one token of lookahead, so this is a simple
+  /// accessor that hot paths (the skipUntil family, isStartOfStmt) can rely
+  /// on being free.
+  const Token &peekToken() { return L->peekNextToken(); }
 
   /// Consumes K tokens within a backtracking scope before calling \c f and
   /// providing it with the backtracking scope. Unless if the backtracking is
@@ -659,7 +672,10 @@ public:
   /// Read tokens until we get to one of the specified tokens, then
   /// return without consuming it.  Because we cannot guarantee that the token
   /// will ever occur, this skips to some likely good stopping point.
-  ParserStatus skipUntil(tok T1, tok T2 = tok::NUM_TOKENS);
+  /// The one-token overload keeps the second kind check out of the skip loop;
+  /// error recovery can spend a long time in here on malformed inputs.
+  ParserStatus skipUntil(tok T1);
+  ParserStatus skipUntil(tok T1, tok T2);
   void skipUntilAnyOperator();
 
   /// Skip until a token that starts with '>', and consume it if found.
@@ -806,12 +822,30 @@ public:
   /// Consume the starting '<' of the current token, which may either
   /// be a complete '<' token or some kind of operator token starting with '<',
   /// e.g., '<>'.
-  SourceLoc consumeStartingLess();
+  ///
+  /// The overwhelmingly common case of a plain one-character token is inline
+  /// so that generic-argument list loops specialize it; longer operators take
+  /// the out-of-line token-splitting path.
+  SourceLoc consumeStartingLess() {
+    assert(startsWithLess(Tok) && "Token does not start with '<'");
+    if (Tok.getLength() == 1) {
+      Tok.setKind(tok::l_angle);
+      return consumeToken();
+    }
+    return consumeStartingCharacterOfCurrentToken(tok::l_angle);
+  }
 
   /// Consume the starting '>' of the current token, which may either
   /// be a complete '>' token or some kind of operator token starting with '>',
-  /// e.g., '>>'.
-  SourceLoc consumeStartingGreater();
+  /// e.g., '>>'. See \c consumeStartingLess for the inline fast path.
+  SourceLoc consumeStartingGreater() {
+    assert(startsWithGreater(Tok) && "Token does not start with '>'");
+    if (Tok.getLength() == 1) {
+      Tok.setKind(tok::r_angle);
+      return consumeToken();
+    }
+    return consumeStartingCharacterOfCurrentToken(tok::r_angle);
+  }
 
   /// Consume the starting character of the current token, and split the
   /// remainder of the token into a new token (or tokens).
@@ -904,10 +938,110 @@ public:
   SourceLoc getErrorOrMissingLoc() const;
 
   /// Parse a comma separated list of some elements.
+  ///
+  /// This is a template so that the element callback can be inlined into the
+  /// list loop instead of being dispatched indirectly per element.
+  template <typename Callback>
   ParserStatus parseList(tok RightK, SourceLoc LeftLoc, SourceLoc &RightLoc,
                          bool AllowSepAfterLast, Diag<> ErrorDiag,
-                         syntax::SyntaxKind Kind,
-                         llvm::function_ref<ParserStatus()> callback);
+                         syntax::SyntaxKind Kind, Callback &&callback) {
+    auto TokIsStringInterpolationEOF = [&]() -> bool {
+      return Tok.is(tok::eof) && Tok.getText() == ")" && RightK == tok::r_paren;
+    };
+
+    llvm::Optional<SyntaxParsingContext> ListContext;
+    ListContext.emplace(SyntaxContext, Kind);
+    if (Kind == syntax::SyntaxKind::Unknown)
+      ListContext->setTransparent();
+
+    syntax::SyntaxKind ElementKind = getListElementKind(Kind);
+
+    if (Tok.is(RightK)) {
+      ListContext.reset();
+      RightLoc = consumeToken(RightK);
+      return makeParserSuccess();
+    }
+    if (TokIsStringInterpolationEOF()) {
+      RightLoc = Tok.getLoc();
+      return makeParserSuccess();
+    }
+
+    ParserStatus Status;
+    while (true) {
+      while (Tok.is(tok::comma)) {
+        diagnose(Tok, diag::unexpected_separator, ",")
+          .fixItRemove(Tok.getLoc());
+        consumeToken();
+      }
+      SourceLoc StartLoc = Tok.getLoc();
+
+      SyntaxParsingContext ElementContext(SyntaxContext, ElementKind);
+      if (ElementKind == syntax::SyntaxKind::Unknown)
+        ElementContext.setTransparent();
+      Status |= callback();
+      if (Tok.is(RightK))
+        break;
+      // If the lexer stopped with an EOF token whose spelling is ")", then this
+      // is actually the tuple that is a string literal interpolation context.
+      // Just accept the ")" and build the tuple as we usually do.
+      if (TokIsStringInterpolationEOF()) {
+        RightLoc = Tok.getLoc();
+        return Status;
+      }
+      // If we haven't made progress, or seeing any error, skip ahead.
+      if (Tok.getLoc() == StartLoc || Status.isErrorOrHasCompletion()) {
+        assert(Status.isErrorOrHasCompletion() && "no progress without error");
+        skipListUntilDeclRBrace(LeftLoc, RightK, tok::comma);
+        if (Tok.is(RightK) || Tok.isNot(tok::comma))
+          break;
+      }
+      if (consumeIf(tok::comma)) {
+        if (Tok.isNot(RightK))
+          continue;
+        if (!AllowSepAfterLast) {
+          diagnose(Tok, diag::unexpected_separator, ",")
+            .fixItRemove(PreviousLoc);
+        }
+        break;
+      }
+      // If we're in a comma-separated list, the next token is at the
+      // beginning of a new line and can never start an element, break.
+      if (Tok.isAtStartOfLine() &&
+          (Tok.is(tok::r_brace) || isStartOfSwiftDecl() || isStartOfStmt())) {
+        break;
+      }
+      // If we found EOF or such, bailout.
+      if (Tok.isAny(tok::eof, tok::pound_endif)) {
+        IsInputIncomplete = true;
+        break;
+      }
+
+      diagnose(Tok, diag::expected_separator, ",")
+        .fixItInsertAfter(PreviousLoc, ",");
+      Status.setIsParseError();
+    }
+
+    ListContext.reset();
+
+    if (Status.isErrorOrHasCompletion()) {
+      // If we've already got errors, don't emit missing RightK diagnostics.
+      if (Tok.is(RightK)) {
+        RightLoc = consumeToken();
+        // Don't propagate the error because we have recovered.
+        if (!Status.hasCodeCompletion())
+          Status = makeParserSuccess();
+      } else {
+        RightLoc = getLocForMissingMatchingToken();
+      }
+    } else if (parseMatchingToken(RightK, RightLoc, ErrorDiag, LeftLoc)) {
+      Status.setIsParseError();
+    }
+
+    return Status;
+  }
+
+  /// Returns the syntax kind of an element in a list of the given kind.
+  static syntax::SyntaxKind getListElementKind(syntax::SyntaxKind ListKind);
 
   void consumeTopLevelDecl(ParserPosition BeginParserPosition,
                            TopLevelCodeDecl *TLCD);
@@ -26,6 +26,11 @@
 
 namespace swift {
 
+// Token kind checks are on the parser's hottest paths; keeping the kind a
+// single byte makes them single-instruction compares and keeps Token itself
+// at 24 bytes on 64-bit hosts.
+static_assert(sizeof(tok) == 1, "token kind is expected to fit in one byte");
+
 /// Token - This structure provides full information about a lexed token.
 /// It is not intended to be space efficient, it is intended to return as much
 /// information as possible about each returned token.  This is expected to be
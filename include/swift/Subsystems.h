@@ -111,6 +111,15 @@ namespace swift {
   void performCodeCompletionSecondPass(SourceFile &SF,
                                        CodeCompletionCallbacksFactory &Factory);
 
+  /// Eagerly parse all function bodies whose parsing was delayed in the
+  /// given source file.
+  ///
+  /// Delayed bodies are normally parsed lazily, on first request. Tools that
+  /// know they will eventually need every body (e.g. whole-file syntax
+  /// consumers) can use this to parse them in one batch instead of faulting
+  /// them in one at a time.
+  void performDelayedParsing(SourceFile &SF);
+
   /// Lex and return a vector of tokens for the given buffer.
   std::vector<Token> tokenize(const LangOptions &LangOpts,
                               const SourceManager &SM, unsigned BufferID,
@@ -25,6 +25,7 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
 // FIXME: Figure out if this can be migrated to LLVM.
@@ -37,6 +38,7 @@ void Parser_registerParseRegexStrawperson(ParseRegexStrawperson fn) {
   parseRegexStrawperson = fn;
 }
 
+#include <cstring>
 #include <limits>
 
 using namespace swift;
@@ -382,6 +384,29 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
 static bool advanceToEndOfLine(const char *&CurPtr, const char *BufferEnd,
                                const char *CodeCompletionPtr = nullptr,
                                DiagnosticEngine *Diags = nullptr) {
+  // Without a diagnostic engine there is no UTF-8 validation or embedded-nul
+  // diagnosis to perform, so the scan only needs to find the next '\n' or
+  // '\r'. Do that a word at a time instead of dispatching per byte; comment
+  // and #! bodies can be long. The byte loop below finishes the tail and
+  // determines the exact stopping point.
+  if (!Diags) {
+    while (BufferEnd - CurPtr >= 8) {
+      uint64_t Word;
+      memcpy(&Word, CurPtr, sizeof(Word));
+      // SWAR byte-equality tests for 0x0A and 0x0D: subtracting 0x01 from
+      // each byte borrows exactly when a byte of Word ^ broadcast(C) is zero.
+      uint64_t LF = Word ^ UINT64_C(0x0A0A0A0A0A0A0A0A);
+      uint64_t CR = Word ^ UINT64_C(0x0D0D0D0D0D0D0D0D);
+      uint64_t Found = ((LF - UINT64_C(0x0101010101010101)) & ~LF &
+                        UINT64_C(0x8080808080808080)) |
+                       ((CR - UINT64_C(0x0101010101010101)) & ~CR &
+                        UINT64_C(0x8080808080808080));
+      if (Found)
+        break;
+      CurPtr += 8;
+    }
+  }
+
   while (1) {
     switch (*CurPtr++) {
     case '\n':
@@ -645,14 +670,27 @@ bool Lexer::isOperator(StringRef string) {
 
 
 tok Lexer::kindOfIdentifier(StringRef Str, bool InSILMode) {
+  // One hashed lookup instead of the long chain of string comparisons the
+  // .def expansion produces; most identifiers are not keywords and used to
+  // walk the whole chain before falling out the bottom.
+  static const llvm::StringMap<tok> Keywords = {
 #define SIL_KEYWORD(kw)
-#define KEYWORD(kw) if (Str == #kw) return tok::kw_##kw;
+#define KEYWORD(kw) {#kw, tok::kw_##kw},
 #include "swift/Syntax/TokenKinds.def"
+  };
+  auto Known = Keywords.find(Str);
+  if (Known != Keywords.end())
+    return Known->second;
 
   // SIL keywords are only active in SIL mode.
   if (InSILMode) {
-#define SIL_KEYWORD(kw) if (Str == #kw) return tok::kw_##kw;
+    static const llvm::StringMap<tok> SILKeywords = {
+#define SIL_KEYWORD(kw) {#kw, tok::kw_##kw},
 #include "swift/Syntax/TokenKinds.def"
+    };
+    auto SILKnown = SILKeywords.find(Str);
+    if (SILKnown != SILKeywords.end())
+      return SILKnown->second;
   }
   return tok::identifier;
 }
@@ -913,6 +951,33 @@ void Lexer::lexOperatorIdentifier() {
   return formToken(leftBound ? tok::oper_postfix : tok::oper_prefix, TokStart);
 }
 
+Optional<Token> Lexer::getSplitRemainderToken(const Token &Tok,
+                                              size_t SplitLen) const {
+  StringRef Rest = Tok.getText().drop_front(SplitLen);
+  // Only handle remainders made up entirely of angle brackets. Anything else
+  // can hit one of the special cases in lexOperatorIdentifier ('=', '&', '.',
+  // '?', "->", "*/", ...) and must be re-lexed instead.
+  if (Rest.empty() || Rest.find_first_not_of("<>") != StringRef::npos)
+    return None;
+
+  // A lone '<' followed by '#' may form an editor placeholder ('<#...#>'),
+  // which only the full lexer knows how to recognize. The buffer is
+  // NUL-terminated, so peeking past the token is safe.
+  if (Rest == "<" && *Rest.end() == '#')
+    return None;
+
+  // The remainder is always left-bound: it is directly preceded by the
+  // operator character that was split off. Since the original token extended
+  // maximally, the remainder ends exactly where the original token did, so
+  // its right-boundedness can be computed from the original token's end.
+  bool rightBound = isRightBound(Rest.end(), /*isLeftBound=*/true,
+                                 CodeCompletionPtr);
+  Token Result;
+  Result.setToken(rightBound ? tok::oper_binary_unspaced : tok::oper_postfix,
+                  Rest);
+  return Result;
+}
+
 /// lexDollarIdent - Match $[0-9a-zA-Z_$]+
 void Lexer::lexDollarIdent() {
   const char *tokStart = CurPtr-1;
@@ -2344,6 +2409,29 @@ void Lexer::getStringLiteralSegments(
                                 CustomDelimiterLen));
 }
 
+bool Lexer::stringLiteralContainsInterpolation(const Token &Str) {
+  assert(Str.is(tok::string_literal));
+  StringRef Bytes = getStringLiteralContent(Str);
+  unsigned CustomDelimiterLen = Str.getCustomDelimiterLen();
+
+  // Mirror the interpolation detection in getStringLiteralSegments: a
+  // backslash followed by a matching custom delimiter and '(' starts an
+  // interpolation segment. A plain find is not enough because raw strings
+  // interpolate with '\#...#(' and '\\' escapes the backslash itself.
+  const char *BytesPtr = Bytes.begin();
+  size_t pos;
+  while ((pos = Bytes.find('\\', BytesPtr-Bytes.begin())) != StringRef::npos) {
+    BytesPtr = Bytes.begin() + pos + 1;
+
+    if (!delimiterMatches(CustomDelimiterLen, BytesPtr, /*Diags=*/nullptr) ||
+        *BytesPtr++ != '(')
+      continue;
+
+    return true;
+  }
+  return false;
+}
+
 
 //===----------------------------------------------------------------------===//
 // Main Lexer Loop
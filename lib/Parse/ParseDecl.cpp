@@ -5226,6 +5226,7 @@ bool Parser::canDelayMemberDeclParsing(bool &HasOperatorDeclarations,
 bool Parser::delayParsingDeclList(SourceLoc LBLoc, SourceLoc &RBLoc,
                                   IterableDeclContext *IDC) {
   bool error = false;
+  SF.recordDelayedMemberList(IDC);
 
   if (Tok.is(tok::r_brace)) {
     RBLoc = consumeToken();
@@ -6896,6 +6897,7 @@ void Parser::consumeAbstractFunctionBody(AbstractFunctionDecl *AFD,
 
   AFD->setBodyDelayed(BodyRange);
   AFD->setHasNestedTypeDeclarations(HasNestedTypeDeclarations);
+  SF.recordDelayedFunctionBody(AFD);
 
   if (isCodeCompletionFirstPass() &&
       SourceMgr.rangeContainsCodeCompletionLoc(BodyRange)) {
@@ -74,9 +74,26 @@ ParseMembersRequest::evaluate(Evaluator &evaluator,
 
   unsigned bufferID = *sf->getBufferID();
 
+  // Restrict the parser to the brace range of the decl list. This avoids
+  // lexing from the top of the buffer just to re-parse a delayed region.
+  SourceRange bodyRange;
+  if (auto *ext = dyn_cast<ExtensionDecl>(idc)) {
+    bodyRange = ext->getBraces();
+  } else {
+    bodyRange = cast<NominalTypeDecl>(idc)->getBraces();
+  }
+  unsigned startOffset = 0, endOffset = 0;
+  if (bodyRange.isValid()) {
+    auto &sourceMgr = ctx.SourceMgr;
+    startOffset = sourceMgr.getLocOffsetInBuffer(bodyRange.Start, bufferID);
+    endOffset = sourceMgr.getLocOffsetInBuffer(
+        Lexer::getLocForEndOfToken(sourceMgr, bodyRange.End), bufferID);
+  }
+
   // Lexer diaganostics have been emitted during skipping, so we disable lexer's
   // diagnostic engine here.
-  Parser parser(bufferID, *sf, /*No Lexer Diags*/nullptr, nullptr, nullptr);
+  Parser parser(bufferID, *sf, /*No Lexer Diags*/nullptr, nullptr, nullptr,
+                startOffset, endOffset);
   // Disable libSyntax creation in the delayed parsing.
   parser.SyntaxContext->disable();
   auto declsAndHash = parser.parseDeclListDelayed(idc);
@@ -117,8 +134,20 @@ BraceStmt *ParseAbstractFunctionBodyRequest::evaluate(
     // FIXME: How do we configure code completion?
     SourceFile &sf = *afd->getDeclContext()->getParentSourceFile();
     SourceManager &sourceMgr = sf.getASTContext().SourceMgr;
-    unsigned bufferID = sourceMgr.findBufferContainingLoc(afd->getLoc());
-    Parser parser(bufferID, sf, /*SIL*/ nullptr);
+    // The source file already knows its buffer; don't binary-search all of
+    // the source manager's buffers for it on every delayed body.
+    unsigned bufferID = *sf.getBufferID();
+
+    // Restrict the parser to the body range. This avoids lexing from the top
+    // of the buffer just to re-parse the one delayed body.
+    auto bodyRange = afd->getBodySourceRange();
+    unsigned startOffset =
+        sourceMgr.getLocOffsetInBuffer(bodyRange.Start, bufferID);
+    unsigned endOffset = sourceMgr.getLocOffsetInBuffer(
+        Lexer::getLocForEndOfToken(sourceMgr, bodyRange.End), bufferID);
+
+    Parser parser(bufferID, sf, /*SIL*/ nullptr, nullptr, nullptr, startOffset,
+                  endOffset);
     parser.SyntaxContext->disable();
     auto body = parser.parseAbstractFunctionBodyDelayed(afd);
     afd->setBodyKind(BodyKind::Parsed);
@@ -36,12 +36,14 @@ using namespace swift::syntax;
 
 /// isStartOfStmt - Return true if the current token starts a statement.
 ///
-bool Parser::isStartOfStmt() {
-  // This needs to be kept in sync with `Parser::parseStmt()`. If a new token
-  // kind is accepted here as start of statement, it should also be handled in
-  // `Parser::parseStmt()`.
-  switch (Tok.getKind()) {
-  default: return false;
+/// Whether a token kind unconditionally begins a statement, without needing
+/// lookahead or line information.
+///
+/// This needs to be kept in sync with `Parser::parseStmt()`. If a new token
+/// kind is accepted here as start of statement, it should also be handled in
+/// `Parser::parseStmt()`.
+static bool isStartOfStmtKeyword(tok Kind) {
+  switch (Kind) {
   case tok::kw_return:
   case tok::kw_throw:
   case tok::kw_defer:
@@ -64,6 +66,15 @@ bool Parser::isStartOfStmt() {
   case tok::pound_error:
   case tok::pound_sourceLocation:
     return true;
+  default:
+    return false;
+  }
+}
+
+bool Parser::isStartOfStmt() {
+  switch (Tok.getKind()) {
+  default:
+    return isStartOfStmtKeyword(Tok.getKind());
 
   case tok::pound_line:
     // #line at the start of a line is a directive, when within, it is an expr.
@@ -72,11 +83,25 @@ bool Parser::isStartOfStmt() {
   case tok::kw_try: {
     // "try" cannot actually start any statements, but we parse it there for
     // better recovery in cases like 'try return'.
+    //
+    // The next token decides the answer by itself in most cases; only fall
+    // back to a backtracking parse when it needs lookahead of its own
+    // (labels, attributes, nested 'try').
+    switch (peekToken().getKind()) {
+    case tok::identifier:
+    case tok::at_sign:
+    case tok::kw_try:
+      break;
+    case tok::pound_line:
+      return peekToken().isAtStartOfLine();
+    default:
+      return isStartOfStmtKeyword(peekToken().getKind());
+    }
     Parser::BacktrackingScope backtrack(*this);
     consumeToken(tok::kw_try);
     return isStartOfStmt();
   }
-      
+
   case tok::identifier: {
     // "identifier ':' for/while/do/switch" is a label on a loop/switch.
     if (!peekToken().is(tok::colon)) {
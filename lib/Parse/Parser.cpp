@@ -40,81 +40,41 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/Twine.h"
 
-static void getStringPartTokens(const swift::Token &Tok,
-                                const swift::LangOptions &LangOpts,
-                                const swift::SourceManager &SM, int BufID,
-                                std::vector<swift::Token> &Toks);
-
-namespace swift {
-template <typename DF>
-void tokenize(const LangOptions &LangOpts, const SourceManager &SM,
-              unsigned BufferID, unsigned Offset, unsigned EndOffset,
-              DiagnosticEngine * Diags,
-              CommentRetentionMode RetainComments,
-              TriviaRetentionMode TriviaRetention,
-              bool TokenizeInterpolatedString, ArrayRef<Token> SplitTokens,
-              DF &&DestFunc) {
-  assert((TriviaRetention != TriviaRetentionMode::WithTrivia ||
-          !TokenizeInterpolatedString) &&
-         "string interpolation with trivia is not implemented yet");
-
-  if (Offset == 0 && EndOffset == 0)
-    EndOffset = SM.getRangeForBuffer(BufferID).getByteLength();
-
-  Lexer L(LangOpts, SM, BufferID, Diags, LexerMode::Swift,
-          HashbangMode::Allowed, RetainComments, TriviaRetention, Offset,
-          EndOffset);
-
-  auto TokComp = [&](const Token &A, const Token &B) {
-    return SM.isBeforeInBuffer(A.getLoc(), B.getLoc());
-  };
-
-  std::set<Token, decltype(TokComp)> ResetTokens(TokComp);
-  for (auto C = SplitTokens.begin(), E = SplitTokens.end(); C != E; ++C) {
-    ResetTokens.insert(*C);
-  }
-
-  Token Tok;
-  StringRef LeadingTrivia, TrailingTrivia;
-  do {
-    L.lex(Tok, LeadingTrivia, TrailingTrivia);
-
-    // If the token has the same location as a reset location,
-    // reset the token stream
-    auto F = ResetTokens.find(Tok);
-    if (F != ResetTokens.end()) {
-      assert(F->isNot(tok::string_literal));
-
-      DestFunc(*F, /*LeadingTrivia=*/StringRef(),
-               /*TrailingTrivia=*/StringRef());
-
-      auto NewState = L.getStateForBeginningOfTokenLoc(
-          F->getLoc().getAdvancedLoc(F->getLength()));
-      L.restoreState(NewState);
-      continue;
-    }
-
-    if (Tok.is(tok::string_literal) && TokenizeInterpolatedString) {
-      std::vector<Token> StrTokens;
-      getStringPartTokens(Tok, LangOpts, SM, BufferID, StrTokens);
-      for (auto &StrTok : StrTokens) {
-        DestFunc(StrTok, /*LeadingTrivia=*/StringRef(),
-                 /*TrailingTrivia=*/StringRef());
-      }
-    } else {
-      DestFunc(Tok, LeadingTrivia, TrailingTrivia);
-    }
-
-  } while (Tok.getKind() != tok::eof);
-}
-} // namespace swift
-
 using namespace swift;
 using namespace swift::syntax;
 using ParsingFlags = SourceFile::ParsingFlags;
 
 void SILParserStateBase::anchor() { }
 
+void swift::performDelayedParsing(SourceFile &SF) {
+  using BodyKind = AbstractFunctionDecl::BodyKind;
+
+  // Make sure the top-level decls have been parsed so the delayed-region
+  // indexes below are populated.
+  (void)SF.getTopLevelDecls();
+
+  // Drain the source file's indexes of delayed member lists and function
+  // bodies instead of walking the AST for them. Both lists can grow while
+  // they are being drained: expanding a member list may delay nested member
+  // lists and bodies, and re-parsing a body may do the same for its local
+  // declarations, so iterate until neither list has pending entries. The
+  // bodies are independent subtrees, but they are parsed serially here
+  // because the request evaluator, the ASTContext allocator and the
+  // diagnostic engine they feed into are all shared, non-thread-safe state.
+  size_t MemberIdx = 0, BodyIdx = 0;
+  while (MemberIdx != SF.getDelayedMemberLists().size() ||
+         BodyIdx != SF.getDelayedFunctionBodies().size()) {
+    for (; MemberIdx != SF.getDelayedMemberLists().size(); ++MemberIdx)
+      (void)SF.getDelayedMemberLists()[MemberIdx]->getMembers();
+
+    for (; BodyIdx != SF.getDelayedFunctionBodies().size(); ++BodyIdx) {
+      auto *AFD = SF.getDelayedFunctionBodies()[BodyIdx];
+      if (AFD->getBodyKind() == BodyKind::Unparsed)
+        (void)AFD->getBody();
+    }
+  }
+}
+
 void swift::performCodeCompletionSecondPass(
     SourceFile &SF, CodeCompletionCallbacksFactory &Factory) {
   return (void)evaluateOrDefault(SF.getASTContext().evaluator,
@@ -210,7 +170,8 @@ void Parser::performCodeCompletionSecondPassImpl(
   assert(!State->hasCodeCompletionDelayedDeclState() &&
          "Second pass should not set any code completion info");
 
-  CodeCompletion->doneParsing();
+  if (CodeCompletion)
+    CodeCompletion->doneParsing();
 
   State->restoreCodeCompletionDelayedDeclState(info);
 }
@@ -235,8 +196,7 @@ void swift::Parser::CancellableBacktrackingScope::cancelBacktrack() {
   TempReceiver.shouldTransfer = true;
 }
 
-/// Tokenizes a string literal, taking into account string interpolation.
-static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
+void swift::getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
                                 const SourceManager &SM,
                                 int BufID, std::vector<Token> &Toks) {
   assert(Tok.is(tok::string_literal));
@@ -245,6 +205,26 @@ static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
   unsigned QuoteLen = (IsMultiline ? 3 : 1) + CustomDelimiterLen;
   SmallVector<Lexer::StringSegment, 4> Segments;
   Lexer::getStringLiteralSegments(Tok, Segments, /*Diags=*/nullptr);
+
+  // The common case is a literal without interpolation: a single Literal
+  // segment that, together with its quotes, covers the whole token.
+  if (Segments.size() == 1 &&
+      Segments.front().Kind == Lexer::StringSegment::Literal) {
+    Lexer::StringSegment &Seg = Segments.front();
+    StringRef Text = SM.extractText(
+        {Seg.Loc.getAdvancedLoc(-QuoteLen), Seg.Length + 2 * QuoteLen});
+    Token NewTok;
+    NewTok.setToken(tok::string_literal, Text);
+    NewTok.setStringLiteral(IsMultiline, CustomDelimiterLen);
+    Toks.push_back(NewTok);
+    return;
+  }
+
+  // Each Literal segment produces one token and each Expr segment a handful;
+  // reserve with a small per-segment estimate so streaming the interpolation
+  // tokens below does not regrow the vector one push at a time.
+  Toks.reserve(Toks.size() + Segments.size() * 4);
+
   for (unsigned i = 0, e = Segments.size(); i != e; ++i) {
     Lexer::StringSegment &Seg = Segments[i];
     bool isFirst = i == 0;
@@ -282,11 +262,19 @@ static void getStringPartTokens(const Token &Tok, const LangOptions &LangOpts,
         Toks.push_back(NewTok);
       }
 
-      std::vector<Token> NewTokens = swift::tokenize(LangOpts, SM, BufID,
-                                                     Offset, EndOffset,
-                                                     /*Diags=*/nullptr,
-                                                     /*KeepComments=*/true);
-      Toks.insert(Toks.end(), NewTokens.begin(), NewTokens.end());
+      // Lex the expression segment directly into Toks. Materializing a
+      // temporary vector per segment would cost an allocation and a copy for
+      // every interpolation.
+      swift::tokenize(LangOpts, SM, BufID, Offset, EndOffset,
+                      /*Diags=*/nullptr, CommentRetentionMode::ReturnAsTokens,
+                      TriviaRetentionMode::WithoutTrivia,
+                      /*TokenizeInterpolatedString=*/true,
+                      /*SplitTokens=*/ArrayRef<Token>(),
+                      [&](const Token &NewTok, StringRef LeadingTrivia,
+                          StringRef TrailingTrivia) {
+                        if (NewTok.isNot(tok::eof))
+                          Toks.push_back(NewTok);
+                      });
 
       if (isLast) {
         // Add a token for the quote character.
@@ -309,6 +297,12 @@ std::vector<Token> swift::tokenize(const LangOptions &LangOpts,
                                    ArrayRef<Token> SplitTokens) {
   std::vector<Token> Tokens;
 
+  // Swift tokens average roughly six bytes of source text. Reserving an
+  // estimate up front avoids growing the vector one token at a time.
+  unsigned EstimatedEndOffset =
+      EndOffset ? EndOffset : SM.getRangeForBuffer(BufferID).getByteLength();
+  Tokens.reserve((EstimatedEndOffset - Offset) / 6);
+
   tokenize(LangOpts, SM, BufferID, Offset, EndOffset, Diags,
            KeepComments ? CommentRetentionMode::ReturnAsTokens
                         : CommentRetentionMode::AttachToNextToken,
@@ -375,14 +369,16 @@ static LexerMode sourceFileKindToLexerMode(SourceFileKind kind) {
 
 Parser::Parser(unsigned BufferID, SourceFile &SF, SILParserStateBase *SIL,
                PersistentParserState *PersistentState,
-               std::shared_ptr<SyntaxParseActions> SPActions)
+               std::shared_ptr<SyntaxParseActions> SPActions, unsigned Offset,
+               unsigned EndOffset)
     : Parser(BufferID, SF, &SF.getASTContext().Diags, SIL, PersistentState,
-             std::move(SPActions)) {}
+             std::move(SPActions), Offset, EndOffset) {}
 
 Parser::Parser(unsigned BufferID, SourceFile &SF, DiagnosticEngine* LexerDiags,
                SILParserStateBase *SIL,
                PersistentParserState *PersistentState,
-               std::shared_ptr<SyntaxParseActions> SPActions)
+               std::shared_ptr<SyntaxParseActions> SPActions, unsigned Offset,
+               unsigned EndOffset)
     : Parser(
           std::unique_ptr<Lexer>(new Lexer(
               SF.getASTContext().LangOpts, SF.getASTContext().SourceMgr,
@@ -396,7 +392,12 @@ Parser::Parser(unsigned BufferID, SourceFile &SF, DiagnosticEngine* LexerDiags,
                   : CommentRetentionMode::None,
               SF.shouldBuildSyntaxTree()
                   ? TriviaRetentionMode::WithTrivia
-                  : TriviaRetentionMode::WithoutTrivia)),
+                  : TriviaRetentionMode::WithoutTrivia,
+              Offset,
+              (Offset == 0 && EndOffset == 0)
+                  ? SF.getASTContext().SourceMgr.getRangeForBuffer(BufferID)
+                        .getByteLength()
+                  : EndOffset)),
           SF, SIL, PersistentState, std::move(SPActions)) {}
 
 namespace {
@@ -497,11 +498,21 @@ public:
     if(Tok.getLoc().isInvalid())
       return;
 
-    // If a token with the same location is already in the bag, skip this token.
-    auto Pos = lower_bound(Tok);
-    if (Pos != Tokens.end() && Pos->getLoc().getOpaquePointerValue() ==
-                                   Tok.getLoc().getOpaquePointerValue()) {
-      return;
+    // Tokens are consumed in source order in the common case, so most
+    // receives append past the last recorded token and no duplicate is
+    // possible. Only out-of-order receives (backtracking, split tokens) need
+    // the binary search and the mid-vector insertion.
+    auto Pos = Tokens.end();
+    if (!Tokens.empty() &&
+        !Ctx.SourceMgr.isBeforeInBuffer(Tokens.back().getLoc(),
+                                        Tok.getLoc())) {
+      // If a token with the same location is already in the bag, skip this
+      // token.
+      Pos = lower_bound(Tok);
+      if (Pos != Tokens.end() && Pos->getLoc().getOpaquePointerValue() ==
+                                     Tok.getLoc().getOpaquePointerValue()) {
+        return;
+      }
     }
 
     // Update Token kind if a kind update was regiestered before.
@@ -537,8 +548,8 @@ Parser::Parser(std::unique_ptr<Lexer> Lex, SourceFile &SF,
           SyntaxContext, SF, L->getBufferID(), std::move(SPActions))) {
   State = PersistentState;
   if (!State) {
-    OwnedState.reset(new PersistentParserState());
-    State = OwnedState.get();
+    OwnedState.emplace();
+    State = OwnedState.getPointer();
   }
 
   // If the interface hash is enabled, set up the initial hash.
@@ -575,10 +586,6 @@ bool Parser::allowTopLevelCode() const {
   return SF.isScriptMode();
 }
 
-const Token &Parser::peekToken() {
-  return L->peekNextToken();
-}
-
 SourceLoc Parser::consumeTokenWithoutFeedingReceiver() {
   SourceLoc Loc = Tok.getLoc();
   assert(Tok.isNot(tok::eof) && "Lexing past eof!");
@@ -631,6 +638,20 @@ SourceLoc Parser::consumeStartingCharacterOfCurrentToken(tok Kind, size_t Len) {
   assert(Tok.getLength() > Len);
   markSplitToken(Kind, Tok.getText().substr(0, Len));
 
+  // In the common case of consecutive angle brackets (nested generic argument
+  // lists, e.g. the '>>' in 'Array<Array<Int>>'), form the remainder token in
+  // place. The lexer has already lexed past the whole token, so it stays
+  // consistent and we avoid re-lexing both the remainder and the token that
+  // follows it.
+  if (auto Remainder = L->getSplitRemainderToken(Tok, Len)) {
+    Tok = *Remainder;
+    // There is no trivia between the split-off prefix and the remainder; the
+    // original token's trailing trivia still follows the remainder.
+    LeadingTrivia = StringRef();
+    PreviousLoc = Loc;
+    return Loc;
+  }
+
   auto NewState = L->getStateForBeginningOfTokenLoc(Loc.getAdvancedLoc(Len));
   restoreParserPosition(ParserPosition(NewState, Loc),
                         /*enableDiagnostics=*/true);
@@ -644,16 +665,6 @@ void Parser::markSplitToken(tok Kind, StringRef Txt) {
   TokReceiver->receive(SplitTokens.back());
 }
 
-SourceLoc Parser::consumeStartingLess() {
-  assert(startsWithLess(Tok) && "Token does not start with '<'");
-  return consumeStartingCharacterOfCurrentToken(tok::l_angle);
-}
-
-SourceLoc Parser::consumeStartingGreater() {
-  assert(startsWithGreater(Tok) && "Token does not start with '>'");
-  return consumeStartingCharacterOfCurrentToken(tok::r_angle);
-}
-
 ParserStatus Parser::skipSingle() {
   ParserStatus status;
   switch (Tok.getKind()) {
@@ -695,6 +706,19 @@ ParserStatus Parser::skipSingle() {
   return status;
 }
 
+ParserStatus Parser::skipUntil(tok T1) {
+  ParserStatus status;
+
+  // tok::NUM_TOKENS is a sentinel that means "don't skip".
+  if (T1 == tok::NUM_TOKENS) return status;
+
+  while (Tok.isNot(T1, tok::eof, tok::pound_endif, tok::pound_else,
+                   tok::pound_elseif))
+    status |= skipSingle();
+
+  return status;
+}
+
 ParserStatus Parser::skipUntil(tok T1, tok T2) {
   ParserStatus status;
 
@@ -911,17 +935,16 @@ Parser::StructureMarkerRAII::StructureMarkerRAII(Parser &parser,
 
 bool Parser::parseIdentifier(Identifier &Result, SourceLoc &Loc,
                              const Diagnostic &D, bool diagnoseDollarPrefix) {
-  switch (Tok.getKind()) {
-  case tok::kw_self:
-  case tok::kw_Self:
-  case tok::identifier:
+  // This runs for every identifier in the source, so test the accepted kinds
+  // directly rather than dispatching through a switch.
+  if (Tok.isAny(tok::identifier, tok::kw_self, tok::kw_Self)) {
     Loc = consumeIdentifier(Result, diagnoseDollarPrefix);
     return false;
-  default:
-    checkForInputIncomplete();
-    diagnose(Tok, D);
-    return true;
   }
+
+  checkForInputIncomplete();
+  diagnose(Tok, D);
+  return true;
 }
 
 bool Parser::parseSpecificIdentifier(StringRef expected, SourceLoc &loc,
@@ -1040,7 +1063,7 @@ SourceLoc Parser::getErrorOrMissingLoc() const {
   return PreviousLoc;
 }
 
-static SyntaxKind getListElementKind(SyntaxKind ListKind) {
+SyntaxKind Parser::getListElementKind(SyntaxKind ListKind) {
   switch (ListKind) {
   case SyntaxKind::TupleExprElementList:
     return SyntaxKind::TupleExprElement;
@@ -1061,105 +1084,6 @@ static SyntaxKind getListElementKind(SyntaxKind ListKind) {
   }
 }
 
-ParserStatus
-Parser::parseList(tok RightK, SourceLoc LeftLoc, SourceLoc &RightLoc,
-                  bool AllowSepAfterLast, Diag<> ErrorDiag, SyntaxKind Kind,
-                  llvm::function_ref<ParserStatus()> callback) {
-  auto TokIsStringInterpolationEOF = [&]() -> bool {
-    return Tok.is(tok::eof) && Tok.getText() == ")" && RightK == tok::r_paren;
-  };
-  
-  llvm::Optional<SyntaxParsingContext> ListContext;
-  ListContext.emplace(SyntaxContext, Kind);
-  if (Kind == SyntaxKind::Unknown)
-    ListContext->setTransparent();
-
-  SyntaxKind ElementKind = getListElementKind(Kind);
-
-  if (Tok.is(RightK)) {
-    ListContext.reset();
-    RightLoc = consumeToken(RightK);
-    return makeParserSuccess();
-  }
-  if (TokIsStringInterpolationEOF()) {
-    RightLoc = Tok.getLoc();
-    return makeParserSuccess();
-  }
-
-  ParserStatus Status;
-  while (true) {
-    while (Tok.is(tok::comma)) {
-      diagnose(Tok, diag::unexpected_separator, ",")
-        .fixItRemove(Tok.getLoc());
-      consumeToken();
-    }
-    SourceLoc StartLoc = Tok.getLoc();
-
-    SyntaxParsingContext ElementContext(SyntaxContext, ElementKind);
-    if (ElementKind == SyntaxKind::Unknown)
-      ElementContext.setTransparent();
-    Status |= callback();
-    if (Tok.is(RightK))
-      break;
-    // If the lexer stopped with an EOF token whose spelling is ")", then this
-    // is actually the tuple that is a string literal interpolation context.
-    // Just accept the ")" and build the tuple as we usually do.
-    if (TokIsStringInterpolationEOF()) {
-      RightLoc = Tok.getLoc();
-      return Status;
-    }
-    // If we haven't made progress, or seeing any error, skip ahead.
-    if (Tok.getLoc() == StartLoc || Status.isErrorOrHasCompletion()) {
-      assert(Status.isErrorOrHasCompletion() && "no progress without error");
-      skipListUntilDeclRBrace(LeftLoc, RightK, tok::comma);
-      if (Tok.is(RightK) || Tok.isNot(tok::comma))
-        break;
-    }
-    if (consumeIf(tok::comma)) {
-      if (Tok.isNot(RightK))
-        continue;
-      if (!AllowSepAfterLast) {
-        diagnose(Tok, diag::unexpected_separator, ",")
-          .fixItRemove(PreviousLoc);
-      }
-      break;
-    }
-    // If we're in a comma-separated list, the next token is at the
-    // beginning of a new line and can never start an element, break.
-    if (Tok.isAtStartOfLine() &&
-        (Tok.is(tok::r_brace) || isStartOfSwiftDecl() || isStartOfStmt())) {
-      break;
-    }
-    // If we found EOF or such, bailout.
-    if (Tok.isAny(tok::eof, tok::pound_endif)) {
-      IsInputIncomplete = true;
-      break;
-    }
-
-    diagnose(Tok, diag::expected_separator, ",")
-      .fixItInsertAfter(PreviousLoc, ",");
-    Status.setIsParseError();
-  }
-
-  ListContext.reset();
-
-  if (Status.isErrorOrHasCompletion()) {
-    // If we've already got errors, don't emit missing RightK diagnostics.
-    if (Tok.is(RightK)) {
-      RightLoc = consumeToken();
-      // Don't propagate the error because we have recovered.
-      if (!Status.hasCodeCompletion())
-        Status = makeParserSuccess();
-    } else {
-      RightLoc = getLocForMissingMatchingToken();
-    }
-  } else if (parseMatchingToken(RightK, RightLoc, ErrorDiag, LeftLoc)) {
-    Status.setIsParseError();
-  }
-
-  return Status;
-}
-
 /// diagnoseRedefinition - Diagnose a redefinition error, with a note
 /// referring back to the original definition.
 
@@ -36,6 +36,11 @@ bool SyntaxParsingCache::nodeCanBeReused(const Syntax &Node, size_t NodeStart,
   if (Node.getKind() != Kind)
     return false;
 
+  // With no edits every node is trivially reusable; don't bother walking to
+  // the next leaf below.
+  if (Edits.empty())
+    return true;
+
   // Node can also not be reused if an edit has been made in the next token's
   // text, e.g. because `private struct Foo {}` parses as a CodeBlockItem with a
   // StructDecl inside and `private struc Foo {}` parses as two CodeBlockItems
@@ -51,6 +56,10 @@ bool SyntaxParsingCache::nodeCanBeReused(const Syntax &Node, size_t NodeStart,
 
   auto NodeEnd = NodeStart + Node.getTextLength();
   for (auto Edit : Edits) {
+    // Edits are sorted by position; once one starts past the range of
+    // interest, none of the remaining edits can affect this node.
+    if (Edit.Start > NodeEnd + NextLeafNodeLength)
+      break;
     // Check if this node or the trivia of the next node has been edited. If it
     // has, we cannot reuse it.
     if (Edit.intersectsOrTouchesRange(NodeStart, NodeEnd + NextLeafNodeLength))
@@ -124,6 +124,34 @@ TEST_F(LexerTest, StringLiteralWithNUL1) {
   EXPECT_EQ(Toks[1].getLength(), 0U);
 }
 
+TEST_F(LexerTest, StringLiteralContainsInterpolation) {
+  const char *Source = "\"plain\" "
+                       "\"pre \\(x) post\" "
+                       "\"escaped \\\\(x)\" "
+                       "\"unicode \\u{41}\" "
+                       "#\"raw \\(x)\"# "
+                       "#\"raw \\#(x)\"#";
+  unsigned BufID = SourceMgr.addMemBufferCopy(StringRef(Source));
+
+  Lexer L(LangOpts, SourceMgr, BufID, /*Diags=*/nullptr, LexerMode::Swift);
+
+  bool Expected[] = {
+    false, // "plain"
+    true,  // "pre \(x) post"
+    false, // "escaped \\(x)" - the backslash is escaped
+    false, // "unicode \u{41}"
+    false, // #"raw \(x)"# - delimiter does not match
+    true,  // #"raw \#(x)"#
+  };
+  for (bool ContainsInterpolation : Expected) {
+    Token Tok;
+    L.lex(Tok);
+    ASSERT_EQ(tok::string_literal, Tok.getKind());
+    EXPECT_EQ(ContainsInterpolation,
+              Lexer::stringLiteralContainsInterpolation(Tok));
+  }
+}
+
 TEST_F(LexerTest, ContentStartHashbangSkip) {
   const char *Source = "#!/usr/bin/swift\naaa";
   
@@ -761,6 +789,38 @@ TEST_F(LexerTest, NestedPlaceholder) {
   EXPECT_EQ("<#aa#>", Toks[2].getText());
 }
 
+TEST_F(LexerTest, SplitRemainderToken) {
+  const char *Source = "a<<b Foo<<#T#>>";
+  unsigned BufID = SourceMgr.addMemBufferCopy(Source);
+  Lexer L(LangOpts, SourceMgr, BufID, /*Diags=*/nullptr, LexerMode::Swift);
+
+  std::vector<Token> Toks;
+  do {
+    Toks.emplace_back();
+    L.lex(Toks.back());
+  } while (Toks.back().isNot(tok::eof));
+  ASSERT_EQ(10U, Toks.size());
+
+  // 'a<<b': splitting off the leading '<' leaves a right-bound '<'.
+  ASSERT_EQ("<<", Toks[1].getText());
+  auto Remainder = L.getSplitRemainderToken(Toks[1], 1);
+  ASSERT_TRUE(Remainder.hasValue());
+  EXPECT_EQ(tok::oper_binary_unspaced, Remainder->getKind());
+  EXPECT_EQ("<", Remainder->getText());
+
+  // 'Foo<<#T#>>': the remainder '<' starts an editor placeholder, so the
+  // split must fall back to re-lexing to form the placeholder token.
+  ASSERT_EQ("<<", Toks[4].getText());
+  EXPECT_FALSE(L.getSplitRemainderToken(Toks[4], 1).hasValue());
+
+  // The closing '>>' is not followed by '#' and splits in place.
+  ASSERT_EQ(">>", Toks[8].getText());
+  Remainder = L.getSplitRemainderToken(Toks[8], 1);
+  ASSERT_TRUE(Remainder.hasValue());
+  EXPECT_EQ(tok::oper_postfix, Remainder->getKind());
+  EXPECT_EQ(">", Remainder->getText());
+}
+
 class StringCaptureDiagnosticConsumer : public DiagnosticConsumer {
 public:
   virtual void handleDiagnostic(SourceManager &SM,